@@ -13,21 +13,78 @@
 //   비교하는 것은 생략되어 있는 관계로 turn around time, waiting time 기준으로는 가장 성능이 떨어지게 나온다.
 //   또한 quantum값이 작을 수록 context switching overhead가 더 많이 발생하게 되는데 이 부분도 생략되었다.
 // 5) FCFS와 SJF의 비교에서는 평균적으로 SJF의 성능이 더 좋은 것으로 나왔다.
-
-#include <stdbool.h>  // #define TRUE 1; #define FALSE 0; 대신 C99부터 추가된 bool 자료형을 이용하기 위해
+// 6) -DLARGE_SCALE 로 컴파일하면 프로세스 1개당 32 bytes 이하를 사용하는 대규모 모드로 동작하며 SUMMARY만 출력한다.
+// 7) -DPROFILE 로 컴파일하고 --profile[=file.json] 옵션을 주면 시뮬레이터 자체의 구간별 실행 시간(cycle)과
+//   연산 횟수를 종료 시 출력하고 JSON 파일(기본값 profile.json)로 저장한다. -DPROFILE 없이 컴파일하면 관련 코드는 모두 빠진다.
+
+#include <inttypes.h>  // int64_t 및 printf/scanf용 PRId64, SCNd64 매크로를 사용하기 위해
+#include <limits.h>    // INT_MAX
+#include <stdbool.h>   // #define TRUE 1; #define FALSE 0; 대신 C99부터 추가된 bool 자료형을 이용하기 위해
+#include <stdint.h>    // uint16_t, uint32_t
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>  // strcmp() 함수를 사용하기 위해
 #include <time.h>    // 난수 생성을 위해 srand()를 time(NULL)로 초기화 해주기 위해
 
+#ifdef PROFILE
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>  // __rdtsc()
+#endif
+#endif
+
+// 시각과 프로세스별 시간은 64비트로 계산한다. (int로는 시뮬레이션 시간이 2^31을 넘으면 overflow가 발생)
+typedef int64_t sim_time_t;
+
+// 모든 프로세스에 대한 시간의 합계는 128비트(GCC/Clang 확장)로 누적한다.
+// 합계는 최대 (프로세스 수 x 시뮬레이션 시간)으로, 10^8개의 프로세스 x 10^12 time units = 10^20 이면 이미 int64의 범위(약 9.2 x 10^18)를 넘는다.
+// 프로세스 수는 int, 시각은 int64 이므로 합계의 절댓값은 2^31 x 2^63 = 2^94 미만이 되어 overflow가 발생하지 않는다.
+__extension__ typedef __int128 sim_total_t;
+
+#ifdef LARGE_SCALE
+// 대규모 모드: -DLARGE_SCALE 로 컴파일 (예: 1억 개의 프로세스, 10^12 time units)
+// 프로세스 1개당 32 bytes 이하를 사용하도록 pcb를 최소한의 필드로 줄인다.
+//  - link는 포인터 대신 process 배열의 index(uint32_t)
+//  - pid는 process 배열의 index이므로 따로 저장하지 않음
+//  - waiting/blocked/turnaround time은 프로세스별로 저장하지 않고 전역 합계에 바로 누적
+//    (프로세스별 결과는 출력하지 않고 SUMMARY만 출력)
+//  - C는 remaining_cpu_time의 초기값으로만, B와 IO는 cburst와 ioburst를 정하는 데에만 쓰이므로 저장하지 않음
+typedef uint32_t pcb_link_t;
+#define LINK_NONE UINT32_MAX           // 다음 pcb가 없음 (NULL 대신)
+#define PCB_TO_LINK(p) ((pcb_link_t)((p) - process))
+#define LINK_TO_PCB(l) ((l) == LINK_NONE ? NULL : &process[(l)])
+#define MAX_CPU_TIME UINT32_MAX        // C의 최댓값
+#define MAX_BURST_TIME UINT16_MAX      // B, IO, quantum의 최댓값
+#define MAX_PROCESSES INT_MAX          // number_of_processes의 최댓값 (LINK_NONE보다 작아야 함)
+
+typedef struct pcb {
+    sim_time_t A;  // 프로세스가 도착한 시각
+    pcb_link_t link;
+
+    uint32_t remaining_cpu_time;
+    uint16_t cburst;  // CPU burst time
+    uint16_t remaining_cburst;
+    uint16_t ioburst;  // IO burst time
+    uint16_t remaining_ioburst;
+    uint16_t remaining_quantum;
+} pcb;
+
+_Static_assert(sizeof(pcb) <= 32, "pcb must fit in 32 bytes in LARGE_SCALE mode");
+#else
+typedef struct pcb* pcb_link_t;
+#define LINK_NONE NULL
+#define PCB_TO_LINK(p) (p)
+#define LINK_TO_PCB(l) (l)
+#define MAX_CPU_TIME INT_MAX
+#define MAX_BURST_TIME INT_MAX
+#define MAX_PROCESSES INT_MAX
+
 // pcb: process control block 자료형
 typedef struct pcb {
-    int pid;  // process id
-    int A;    // 프로세스가 도착한 시각
-    int C;    // 프로세스가 종료될 때까지 필요로 하는 총 CPU time
-    int B;    // cburst는 0과 B사이의 랜덤한 정수
-    int IO;   // ioburst는 0과 IO사이의 랜덤한 정수
-    struct pcb* link;
+    sim_time_t A;  // 프로세스가 도착한 시각
+    int C;         // 프로세스가 종료될 때까지 필요로 하는 총 CPU time
+    int B;         // cburst는 0과 B사이의 랜덤한 정수
+    int IO;        // ioburst는 0과 IO사이의 랜덤한 정수
+    pcb_link_t link;
 
     int remaining_cpu_time;
     int cburst;  // CPU burst time
@@ -37,94 +94,212 @@ typedef struct pcb {
     int remaining_quantum;
 
     // summury data 출력을 위한 변수들
-    int turnaround_time;     // completion_time - A(=arrival time)
-                             // turnaround time은 CPU time, IO time, Waiting time의 합으로 검산이 가능
-    int ready_start_time;    // ready_queue에 들어간 시각
-    int ready_end_time;      // ready_queue에서 나온 시각
-    int waiting_time;        // ready_end_time - ready_start_time
-    int blocked_start_time;  // block_queue에 들어간 시각
-    int blocked_end_time;    // block_queue에서 나온 시각
-    int blocked_time;        // blocked_end_time - blocked_start_time
-    int completion_time;     // 해당 프로세스가 종료된 시각
+    sim_time_t turnaround_time;     // completion_time - A(=arrival time)
+                                    // turnaround time은 CPU time, IO time, Waiting time의 합으로 검산이 가능
+    sim_time_t ready_start_time;    // ready_queue에 들어간 시각
+    sim_time_t ready_end_time;      // ready_queue에서 나온 시각
+    sim_time_t waiting_time;        // ready_end_time - ready_start_time
+    sim_time_t blocked_start_time;  // block_queue에 들어간 시각
+    sim_time_t blocked_end_time;    // block_queue에서 나온 시각
+    sim_time_t blocked_time;        // blocked_end_time - blocked_start_time
+    sim_time_t completion_time;     // 해당 프로세스가 종료된 시각
 
 } pcb;
-
-// Linked List 로 Queue를 구현해주기 위해 node 자료형을 선언
-typedef struct node {
-    pcb process;
-    struct node* next;
-} node;
+#endif
 
 // 문제에서 주어진 형태의 queue_t 자료형
+// 각 pcb의 link로 다음 pcb를 연결하므로 (intrusive linked list) enqueue할 때마다 node를 malloc하지 않는다.
+// 한 프로세스는 동시에 두 개 이상의 queue에 들어갈 수 없다.
 typedef struct queue_t {
     pcb* first;  // head, front 등으로도 불림
     pcb* last;   // tail, rear  등으로도 불림
     int count;   // queue 안에 있는 data의 수
+#ifdef PROFILE
+    int peak;  // count의 최댓값
+#endif
 } queue_t;
 
 // global variables
 int number_of_processes = 0;       // 총 프로세스의 수
+pcb* process = NULL;               // 프로세스 구조체 배열 (pid는 이 배열의 index)
 bool is_all_finished = false;      // 모든 프로세스가 종료되면 true
 char* sched_algorithm_title = "";  // 선택한 스케쥴러 알고리즘을 저장하기 위한 char* 타입
 int quantum = 0;                   // Round Robin의 preemptive 부분 구현을 위한 time slice
 
-int finishing_time = 0;  // 모든 프로세스를 마치고 프로그램이 끝난 시각, 즉 마지막 프로세스가 종료된 시각
-int idle_time = 0;       // CPU 유휴시간 (running queue가 비어있으면 ++)
-double cpu_util = 0;     // CPU Utilization 0~1 사이의 값
-double io_util = 0;      // IO Utilization 0~1 사이의 값
-int total_turnaround_time = 0;
-int total_waiting_time = 0;
-int total_blocked_time = 0;
+sim_time_t finishing_time = 0;  // 모든 프로세스를 마치고 프로그램이 끝난 시각, 즉 마지막 프로세스가 종료된 시각
+sim_time_t idle_time = 0;       // CPU 유휴시간 (running queue가 비어있으면 ++)
+double cpu_util = 0;            // CPU Utilization 0~1 사이의 값
+double io_util = 0;             // IO Utilization 0~1 사이의 값
+sim_total_t total_turnaround_time = 0;
+sim_total_t total_waiting_time = 0;
+sim_total_t total_blocked_time = 0;
 double avg_turnaround_time = 0;  // Average Turnaround Time
 double avg_waiting_time = 0;     // Average Waiting Time
 double throughput_per_unit = 0;  // 단위 시간 당 throuughput
 
-void queue_init(queue_t* queue);            // queue를 초기화
-bool is_empty(queue_t* queue);              // queue가 비어있으면 true를 return
-void enqueue(queue_t* queue, pcb process);  // queue의 last(맨 뒤)에  process를 넣음
-pcb dequeue(queue_t* queue);                // queue의 first(맨 앞)에서 process를 꺼냄 (꺼낸 pcb를 return)
+void queue_init(queue_t* queue);              // queue를 초기화
+bool is_empty(queue_t* queue);                // queue가 비어있으면 true를 return
+void enqueue(queue_t* queue, pcb* p);         // queue의 last(맨 뒤)에  process를 넣음
+void enqueue_sorted(queue_t* queue, pcb* p);  // remaining_cpu_time 오름차순을 유지하도록 process를 넣음 (같으면 먼저 들어온 순서대로)
+pcb* dequeue(queue_t* queue);                 // queue의 first(맨 앞)에서 process를 꺼냄 (꺼낸 pcb를 return)
+
+// qsort()로 process 배열을 정렬하기 위한 비교 함수
+// 정렬 전까지 link에는 입력 파일에서의 순서가 저장되어 있으므로 마지막 기준으로 사용한다
+int compare_arrival(const void* a, const void* b);           // A, 입력 순서
+int compare_arrival_cpu_time(const void* a, const void* b);  // A, C, 입력 순서
+
+// 상태 전이 시 summary data를 기록 (LARGE_SCALE 모드에서는 전역 합계에 바로 누적)
+void ready_in(pcb* p, sim_time_t now);     // ready_queue에 들어감
+void ready_out(pcb* p, sim_time_t now);    // ready_queue에서 나와서 running으로
+void blocked_in(pcb* p, sim_time_t now);   // blocked_queue에 들어감
+void blocked_out(pcb* p, sim_time_t now);  // blocked_queue에서 나옴 (IO작업 완료)
+void complete(pcb* p, sim_time_t now);     // 프로세스 종료
+
+#ifdef PROFILE
+// 시뮬레이터 자체의 self-profiling (-DPROFILE 로 컴파일했을 때만 포함됨)
+// 매 time unit의 반복문을 다음 구간(phase)으로 나누어 구간별 실행 시간을 누적한다.
+enum prof_phase {
+    PHASE_SETUP,        // 파일 읽기와 도착 시각 순 정렬
+    PHASE_ARRIVAL,      // 도착한 프로세스를 찾아서 ready_queue로 (SJF는 순서대로 넣는 시간 포함)
+    PHASE_DISPATCH,     // running state 처리 (dispatch, 실행, 종료, preemption)
+    PHASE_BLOCKED,      // blocked_queue 순회 (IO 작업, SJF는 ready_queue에 순서대로 넣는 시간 포함)
+    PHASE_COUNT
+};
+
+typedef struct prof_t {
+    uint64_t phase_time[PHASE_COUNT];  // 구간별 실행 시간 (x86에서는 TSC cycle, 그 외에는 ns)
+    uint64_t enqueues;
+    uint64_t dequeues;
+    uint64_t allocations;        // malloc 호출 횟수
+    uint64_t context_switches;   // ready_queue에서 running으로 dispatch된 횟수
+    uint64_t ready_queue_steps;  // SJF에서 ready_queue에 순서대로 넣기 위해 지나친 pcb의 수
+    uint64_t ticks;              // 반복문을 수행한 time unit의 수
+    uint64_t events;             // 상태 전이 횟수 (도착, dispatch, preemption, IO 시작/완료, 종료)
+    int peak_ready_queue;
+    int peak_blocked_queue;
+} prof_t;
+
+prof_t prof;                  // 모든 값은 0으로 초기화됨
+bool prof_enabled = false;    // --profile 옵션을 주었을 때만 구간별 시간을 측정
+uint64_t prof_last_time = 0;  // 직전 구간이 끝난 시각
+
+uint64_t prof_timer(void);                               // 현재 시각 (cycle 또는 ns)
+void prof_lap(enum prof_phase phase);                    // 직전 구간이 끝난 뒤 지금까지의 시간을 phase에 누적
+void prof_report(void);                                  // 결과를 표로 출력
+bool prof_write_json(const char* path);                  // 결과를 JSON으로 저장
+
+#define PROF_COUNT(counter) (prof.counter++)
+#define PROF_LAP(phase) (prof_enabled ? prof_lap(phase) : (void)0)
+#else
+#define PROF_COUNT(counter) ((void)0)
+#define PROF_LAP(phase) ((void)0)
+#endif
 
 // 메인 시작 ./sched [filename] [scheduling method: fcfs, sjf, or rr]
 int main(int argc, char** argv) {
     srand(time(NULL));  // 난수 생성
 
+    // --profile[=file.json] 옵션은 위치에 상관없이 받아서 argv에서 빼낸다
+    const char* profile_path = NULL;
+    int arg_count = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--profile", 9) == 0 && (argv[i][9] == '\0' || argv[i][9] == '=')) {
+            profile_path = (argv[i][9] == '=') ? &argv[i][10] : "profile.json";
+        } else {
+            argv[arg_count++] = argv[i];
+        }
+    }
+    argc = arg_count;
+
     if (argc != 3 && argc != 4) {
-        printf("Usage: ./sched [filename] [scheduling algorithm: fcfs, sjf, or rr] [quantum]\nIf you use rr, then you must provide quantum argument.\n");
+        printf("Usage: ./sched [filename] [scheduling algorithm: fcfs, sjf, or rr] [quantum] [--profile[=file.json]]\nIf you use rr, then you must provide quantum argument.\n");
         return 1;
     }
+
+#ifdef PROFILE
+    if (profile_path != NULL) {
+        prof_enabled = true;
+        prof_last_time = prof_timer();
+    }
+#else
+    if (profile_path != NULL) {
+        printf("error: --profile is not available. Compile with -DPROFILE to use it.\n");
+        return 1;
+    }
+#endif
     FILE* file = fopen(argv[1], "r");
     if (file == NULL) {
         printf("Error! Could not open the file\n");
         return 1;
     }
 
-    fscanf(file, "%d", &number_of_processes);  // 프로세스의 수를 저장
+    // 프로세스의 수를 저장
+    if (fscanf(file, "%d", &number_of_processes) != 1) {
+        printf("error: could not read the number of processes at line 1\n");
+        fclose(file);
+        return 1;
+    }
     printf("\nnumber of processes: %d\n\n", number_of_processes);
+    if (number_of_processes <= 0 || number_of_processes > MAX_PROCESSES) {
+        printf("error: number of processes should be between 1 and %d\n", MAX_PROCESSES);
+        fclose(file);
+        return 1;
+    }
 
-    pcb* process;
-    // 프로세스 구조체 배열을 동적 할당할 포인터 변수 선언
+    // 프로세스 구조체 배열을 동적 할당할 포인터 변수는 전역변수 process
     /* number_of_processes 만큼의 크기의 프로세스 구조체의 배열을 동적으로 할당 */
 
-    process = (pcb*)malloc(number_of_processes * sizeof(pcb));
+    process = (pcb*)malloc((size_t)number_of_processes * sizeof(pcb));
+    PROF_COUNT(allocations);
+    if (process == NULL) {
+        printf("Error! Could not allocate memory for %d processes\n", number_of_processes);
+        fclose(file);
+        return 1;
+    }
     for (int i = 0; i < number_of_processes; ++i) {
         // txt파일로부터 A, C, B, IO를 각각 불러옴
-        fscanf(file, "%d %d %d %d", &process[i].A, &process[i].C, &process[i].B, &process[i].IO);
+        sim_time_t A;
+        long long C, B, IO;
+        // 4개의 값을 모두 읽었는지, pcb의 각 필드에 담을 수 있는 값인지 확인
+        if (fscanf(file, "%" SCNd64 " %lld %lld %lld", &A, &C, &B, &IO) != 4 ||
+            A < 0 || C <= 0 || C > MAX_CPU_TIME || B < 0 || B > MAX_BURST_TIME || IO < 0 || IO > MAX_BURST_TIME) {
+            printf("error: invalid process data at line %d (A >= 0, 0 < C <= %lld, 0 <= B, IO <= %lld)\n",
+                   i + 2, (long long)MAX_CPU_TIME, (long long)MAX_BURST_TIME);
+            free(process);
+            fclose(file);
+            return 1;
+        }
+        process[i].A = A;
+#ifndef LARGE_SCALE
+        process[i].C = (int)C;
+        process[i].B = (int)B;
+        process[i].IO = (int)IO;
+#endif
 
         // rand() % x 에서 x가 0이면 floating point exception이 발생하므로
-        process[i].cburst = (rand() % (process[i].B + 1));
-        process[i].ioburst = (rand() % (process[i].IO + 1));
+        process[i].cburst = (rand() % (B + 1));
+        process[i].ioburst = (rand() % (IO + 1));
 
         // cburst 가 0이 되어서는 안되므로 랜덤으로 0이 나왔으면 1을 배정함
         if (process[i].cburst == 0) {
             process[i].cburst = 1;
         }
 
+        // 정렬할 때 같은 값이면 입력 파일의 순서를 유지하기 위해 queue에 들어가기 전까지는 link에 자신의 위치를 저장
+#ifdef LARGE_SCALE
+        process[i].link = (pcb_link_t)i;
+#else
+        process[i].link = &process[i];
+#endif
+
         // 계산을 위해 다음 (remaining) 변수들을 초기화함
         process[i].remaining_cburst = process[i].cburst;
         process[i].remaining_ioburst = process[i].ioburst;
-        process[i].remaining_cpu_time = process[i].C;
+        process[i].remaining_cpu_time = C;
+#ifndef LARGE_SCALE
         process[i].waiting_time = 0;
         process[i].blocked_time = 0;
+#endif
     }
     // 열어준 파일포인터 file을  닫아준다.
     fclose(file);
@@ -141,9 +316,9 @@ int main(int argc, char** argv) {
     queue_init(&blocked_queue);
     queue_init(&complete_queue);
 
-    int count_time = 0;      //  while (!is_all_finished){...} 반복문을 수행하면서 1씩 증가 (time unit을 구현)
-    int process_index = 0;   // 프로세스를 ready큐로 넣어줄 때 for문을 위한 index 변수
-    int finished_count = 0;  // 완료된 프로세스의 수. number_of_processes와 같아지면 while문 종료
+    sim_time_t count_time = 0;  //  while (!is_all_finished){...} 반복문을 수행하면서 1씩 증가 (time unit을 구현)
+    int process_index = 0;      // 프로세스를 ready큐로 넣어줄 때 for문을 위한 index 변수
+    int finished_count = 0;     // 완료된 프로세스의 수. number_of_processes와 같아지면 while문 종료
 
     //
     //  First Come First Served (FCFS)
@@ -152,29 +327,27 @@ int main(int argc, char** argv) {
     if (strcmp(argv[2], "fcfs") == 0) {
         sched_algorithm_title = "First Come First Served (FCFS)";
 
-        // 도착 시간 순서대로 버블정렬
-        for (int i = 0; i < number_of_processes; ++i) {
-            for (int j = i + 1; j < number_of_processes; ++j) {
-                if (process[i].A > process[j].A) {
-                    pcb tmp = process[i];
-                    process[i] = process[j];
-                    process[j] = tmp;
-                }
-            }
-            // 정렬된 순서대로 process id를 부여함
-            process[i].pid = i;  // pid
-        }
+        // 도착 시간 순서대로 정렬 (같은 시각에 도착했으면 입력 파일의 순서대로)
+        // 정렬된 순서 (process 배열의 index)가 곧 process id
+        qsort(process, number_of_processes, sizeof(pcb), compare_arrival);
+
+        PROF_LAP(PHASE_SETUP);
 
         // while loop 시작 count time++
         while (!is_all_finished) {
             // process의 A(도착시각)를 체크해서 arrival time이 되면 ready queue에 enqueue
+            // process 배열은 도착 시각 순으로 정렬되어 있으므로 아직 도착하지 않은 프로세스를 만나면 멈춘다
             for (int i = process_index; i < number_of_processes; ++i) {
+                if (process[i].A > count_time) {
+                    break;
+                }
                 if (process[i].A == count_time) {
-                    process[i].ready_start_time = count_time;
-                    enqueue(&ready_queue, process[i]);
+                    ready_in(&process[i], count_time);
+                    enqueue(&ready_queue, &process[i]);
                     process_index++;
                 }
             }
+            PROF_LAP(PHASE_ARRIVAL);
 
             // printf("time: %d ready_queue count: %d\n", count_time, ready_queue.count);
 
@@ -190,9 +363,8 @@ int main(int argc, char** argv) {
                 }
                 // ready_queue에 process가 있는 경우 가져와서 running으로
                 else {
-                    pcb tmp = dequeue(&ready_queue);
-                    tmp.ready_end_time = count_time;
-                    tmp.waiting_time += (tmp.ready_end_time - tmp.ready_start_time);
+                    pcb* tmp = dequeue(&ready_queue);
+                    ready_out(tmp, count_time);
                     enqueue(&running_queue, tmp);
                 }
             }
@@ -203,15 +375,11 @@ int main(int argc, char** argv) {
 
                 // CPU time만큼 running state에 있었으면 프로세스를 종료하고 complete_queue로 보낸다
                 if (running_queue.first->remaining_cpu_time == 0) {
-                    pcb tmp = dequeue(&running_queue);
-                    tmp.completion_time = count_time;
-                    tmp.turnaround_time = tmp.completion_time - tmp.A;
-
-                    total_turnaround_time += tmp.turnaround_time;
-                    total_waiting_time += tmp.waiting_time;
-                    total_blocked_time += tmp.blocked_time;
-
+                    pcb* tmp = dequeue(&running_queue);
+                    complete(tmp, count_time);
+#ifndef LARGE_SCALE
                     enqueue(&complete_queue, tmp);
+#endif
                     finished_count++;
                 }
                 // 현재 running process 의 cpu burst time이 0가 되면
@@ -223,31 +391,32 @@ int main(int argc, char** argv) {
                     }
                     // ioburst != 0 일 경우 IO작업을 하기 위해 blocked queue로 보냄
                     else {
-                        pcb tmp = dequeue(&running_queue);
+                        pcb* tmp = dequeue(&running_queue);
                         // IO작업을 위해 blocked_queue로 보낸다
-                        tmp.blocked_start_time = count_time;
+                        blocked_in(tmp, count_time);
                         // remaining_ioburst ioburst 를 다시 초기화 해준다
-                        tmp.remaining_ioburst = tmp.ioburst;
+                        tmp->remaining_ioburst = tmp->ioburst;
                         enqueue(&blocked_queue, tmp);
                     }
                 }
             }
 
+            PROF_LAP(PHASE_DISPATCH);
+
             // blocked_queue가 비어있지 않으면
             // io도 한 번에 1개의 프로세스만 io작업을 한다고 가정
             if (!is_empty(&blocked_queue)) {
                 // blocked_queue에 있는 프로세스의 수만큼 for문을 돌리기 위해
                 int process_count = blocked_queue.count;
                 for (int i = 0; i < process_count; ++i) {
-                    pcb tmp = dequeue(&blocked_queue);
-                    tmp.remaining_ioburst--;
+                    pcb* tmp = dequeue(&blocked_queue);
+                    tmp->remaining_ioburst--;
 
                     //block queue에 있는 io작업이 끝난 프로세스가 있으면
-                    if (tmp.remaining_ioburst == 0) {
-                        tmp.blocked_end_time = count_time;
-                        tmp.blocked_time += (tmp.blocked_end_time - tmp.blocked_start_time);
-                        tmp.remaining_cburst = tmp.cburst;
-                        tmp.ready_start_time = count_time;
+                    if (tmp->remaining_ioburst == 0) {
+                        blocked_out(tmp, count_time);
+                        tmp->remaining_cburst = tmp->cburst;
+                        ready_in(tmp, count_time);
                         enqueue(&ready_queue, tmp);
                     }
                     // 아직 IO 작업이 남아있으면 다시 blocked_queue에 넣어준다
@@ -256,6 +425,7 @@ int main(int argc, char** argv) {
                     }
                 }
             }
+            PROF_LAP(PHASE_BLOCKED);
 
             // 모든 프로세스가 완료되면 Finishing time을 기록하고 while반복문을 빠져나간다.
             if (finished_count == number_of_processes) {
@@ -264,6 +434,7 @@ int main(int argc, char** argv) {
             }
 
             count_time++;
+            PROF_COUNT(ticks);
         }
 
     }
@@ -279,35 +450,39 @@ int main(int argc, char** argv) {
             printf("error: quantum should be greater than 0\n");
             exit(2);
         }
+        if (quantum > MAX_BURST_TIME) {
+            printf("error: quantum should not be greater than %lld\n", (long long)MAX_BURST_TIME);
+            exit(2);
+        }
 
-        // 도착 시간 순서대로 버블정렬
-        for (int i = 0; i < number_of_processes; ++i) {
-            for (int j = i + 1; j < number_of_processes; ++j) {
-                if (process[i].A > process[j].A) {
-                    pcb tmp = process[i];
-                    process[i] = process[j];
-                    process[j] = tmp;
-                }
-            }
-            // 정렬된 순서대로 process id를 부여함
-            process[i].pid = i;  // pid
+        // 도착 시간 순서대로 정렬 (같은 시각에 도착했으면 입력 파일의 순서대로)
+        // 정렬된 순서 (process 배열의 index)가 곧 process id
+        qsort(process, number_of_processes, sizeof(pcb), compare_arrival);
 
+        for (int i = 0; i < number_of_processes; ++i) {
             // RR specific
             // quantum(= time slice)만큼 time unit이 지나면 running state에 있는 프로세스를
             // ready_queue의 맨 뒤로 보내는, 즉 교체해주기 위해 remaining_quantum을 설정해줌
             process[i].remaining_quantum = quantum;
         }
 
+        PROF_LAP(PHASE_SETUP);
+
         // while loop 시작 count time++
         while (!is_all_finished) {
             // process의 A(도착시각)를 체크해서 arrival time이 되면 ready queue에 enqueue
+            // process 배열은 도착 시각 순으로 정렬되어 있으므로 아직 도착하지 않은 프로세스를 만나면 멈춘다
             for (int i = process_index; i < number_of_processes; ++i) {
+                if (process[i].A > count_time) {
+                    break;
+                }
                 if (process[i].A == count_time) {
-                    process[i].ready_start_time = count_time;
-                    enqueue(&ready_queue, process[i]);
+                    ready_in(&process[i], count_time);
+                    enqueue(&ready_queue, &process[i]);
                     process_index++;
                 }
             }
+            PROF_LAP(PHASE_ARRIVAL);
 
             // CPU를 1개로 가정했기 때문에 running state에는 1개의 프로세스만 온다
             //running_queue가 비어 있는 상태면 ready queue에서 프로세스를 가져옴
@@ -321,9 +496,8 @@ int main(int argc, char** argv) {
                 }
                 // ready_queue에 process가 있는 경우 가져와서 running으로
                 else {
-                    pcb tmp = dequeue(&ready_queue);
-                    tmp.ready_end_time = count_time;
-                    tmp.waiting_time += (tmp.ready_end_time - tmp.ready_start_time);
+                    pcb* tmp = dequeue(&ready_queue);
+                    ready_out(tmp, count_time);
                     enqueue(&running_queue, tmp);
                 }
             }
@@ -337,23 +511,19 @@ int main(int argc, char** argv) {
 
                 // CPU time만큼 running state에 있었으면 프로세스를 종료하고 complete_queue로 보낸다
                 if (running_queue.first->remaining_cpu_time == 0) {
-                    pcb tmp = dequeue(&running_queue);
-                    tmp.completion_time = count_time;
-                    tmp.turnaround_time = tmp.completion_time - tmp.A;
-
-                    total_turnaround_time += tmp.turnaround_time;
-                    total_waiting_time += tmp.waiting_time;
-                    total_blocked_time += tmp.blocked_time;
-
+                    pcb* tmp = dequeue(&running_queue);
+                    complete(tmp, count_time);
+#ifndef LARGE_SCALE
                     enqueue(&complete_queue, tmp);
+#endif
                     finished_count++;
                 }
                 // remaining quantum이 0이 되면 remaining_quantum을 다시 quantum으로 초기화 해주고
                 // ready queue로 보낸다
                 else if (running_queue.first->remaining_quantum == 0) {
-                    pcb tmp = dequeue(&running_queue);
-                    tmp.remaining_quantum = quantum;
-                    tmp.ready_start_time = count_time;
+                    pcb* tmp = dequeue(&running_queue);
+                    tmp->remaining_quantum = quantum;
+                    ready_in(tmp, count_time);
                     enqueue(&ready_queue, tmp);
                 }
                 // 현재 running process 의 cpu burst time이 0가 되면
@@ -365,31 +535,32 @@ int main(int argc, char** argv) {
                     }
                     // ioburst != 0 일 경우 IO작업을 하기 위해 blocked queue로 보냄
                     else {
-                        pcb tmp = dequeue(&running_queue);
+                        pcb* tmp = dequeue(&running_queue);
                         // IO작업을 위해 blocked_queue로 보낸다
-                        tmp.blocked_start_time = count_time;
+                        blocked_in(tmp, count_time);
                         // remaining_ioburst ioburst 를 다시 초기화 해준다
-                        tmp.remaining_ioburst = tmp.ioburst;
+                        tmp->remaining_ioburst = tmp->ioburst;
                         enqueue(&blocked_queue, tmp);
                     }
                 }
             }
 
+            PROF_LAP(PHASE_DISPATCH);
+
             // blocked_queue가 비어있지 않으면
             // io도 한 번에 1개의 프로세스만 io작업을 한다고 가정
             if (!is_empty(&blocked_queue)) {
                 // blocked_queue에 있는 프로세스의 수만큼 for문을 돌리기 위해
                 int process_count = blocked_queue.count;
                 for (int i = 0; i < process_count; ++i) {
-                    pcb tmp = dequeue(&blocked_queue);
-                    tmp.remaining_ioburst--;
+                    pcb* tmp = dequeue(&blocked_queue);
+                    tmp->remaining_ioburst--;
 
                     //block queue에 있는 io작업이 끝난 프로세스가 있으면
-                    if (tmp.remaining_ioburst == 0) {
-                        tmp.blocked_end_time = count_time;
-                        tmp.blocked_time += (tmp.blocked_end_time - tmp.blocked_start_time);
-                        tmp.remaining_cburst = tmp.cburst;
-                        tmp.ready_start_time = count_time;
+                    if (tmp->remaining_ioburst == 0) {
+                        blocked_out(tmp, count_time);
+                        tmp->remaining_cburst = tmp->cburst;
+                        ready_in(tmp, count_time);
                         enqueue(&ready_queue, tmp);
                     }
                     // 아직 IO 작업이 남아있으면 다시 blocked_queue에 넣어준다
@@ -398,6 +569,7 @@ int main(int argc, char** argv) {
                     }
                 }
             }
+            PROF_LAP(PHASE_BLOCKED);
 
             // 모든 프로세스가 완료되면 Finishing time을 기록하고 while반복문을 빠져나간다.
             if (finished_count == number_of_processes) {
@@ -406,6 +578,7 @@ int main(int argc, char** argv) {
             }
 
             count_time++;
+            PROF_COUNT(ticks);
         }
 
     }
@@ -417,64 +590,28 @@ int main(int argc, char** argv) {
         sched_algorithm_title = "Shortest Job First (SJF)";
 
         // SJF specific 정렬 : 도착한 시각 순서대로 정렬하되
-        // 같은 시각에 도착했으면 C 기준으로 다시 오름차순 정렬한다
-        for (int i = 0; i < number_of_processes; ++i) {
-            for (int j = i + 1; j < number_of_processes; ++j) {
-                // 먼저 프로세스들을 다시 C (CPU time 즉, 총 cburst의 합계) 순으로 버블 정렬
-                for (int k = j; k < number_of_processes; ++k) {
-                    if (process[i].C > process[j].C) {
-                        pcb tmp = process[i];
-                        process[i] = process[j];
-                        process[j] = tmp;
-                    }
-                }
-                // 도착한 시간 순서대로 버블정렬
-                if (process[i].A > process[j].A) {
-                    pcb tmp = process[i];
-                    process[i] = process[j];
-                    process[j] = tmp;
-                }
-            }
-            // 정렬된 순서대로 process id를 부여함
-            process[i].pid = i;  // pid
-        }
+        // 같은 시각에 도착했으면 C 기준으로 다시 오름차순 정렬한다 (C도 같으면 입력 파일의 순서대로)
+        // 정렬된 순서 (process 배열의 index)가 곧 process id
+        qsort(process, number_of_processes, sizeof(pcb), compare_arrival_cpu_time);
+
+        PROF_LAP(PHASE_SETUP);
 
         // while loop 시작 count time++
         while (!is_all_finished) {
             // process의 A(도착시각)를 체크해서 arrival time이 되면 ready queue에 enqueue
+            // process 배열은 도착 시각 순으로 정렬되어 있으므로 아직 도착하지 않은 프로세스를 만나면 멈춘다
             for (int i = process_index; i < number_of_processes; ++i) {
+                if (process[i].A > count_time) {
+                    break;
+                }
                 if (process[i].A == count_time) {
-                    process[i].ready_start_time = count_time;
-                    enqueue(&ready_queue, process[i]);
+                    ready_in(&process[i], count_time);
+                    enqueue_sorted(&ready_queue, &process[i]);
                     process_index++;
                 }
             }
+            PROF_LAP(PHASE_ARRIVAL);
 
-            // ready_queue에 있는 프로세스들을 remaining cpu time 순으로 정렬
-
-            // ready queue에 있는 프로세스 수를 변수를 선언해서 저장
-            int ready_queue_count = ready_queue.count;
-            // ready_process 배열을 힙메모리에 할당해서 ready_queue에서 dequeue로 빼와서 저장
-            pcb* ready_process = (pcb*)malloc(ready_queue_count * sizeof(pcb));
-            for (int i = 0; i < ready_queue_count; ++i) {
-                ready_process[i] = dequeue(&ready_queue);
-            }
-            // remaining_cpu_time 오름차순 순으로 버블정렬
-            for (int i = 0; i < ready_queue_count; ++i) {
-                for (int j = i + 1; j < ready_queue_count; ++j) {
-                    if (ready_process[i].remaining_cpu_time > ready_process[j].remaining_cpu_time) {
-                        pcb tmp = ready_process[i];
-                        ready_process[i] = ready_process[j];
-                        ready_process[j] = tmp;
-                    }
-                }
-            }
-            // 정렬된 순서로 다시 ready_queue에 넣어줌
-            for (int i = 0; i < ready_queue_count; ++i) {
-                enqueue(&ready_queue, ready_process[i]);
-            }
-            // ready_process배열의 메모리 할당 해제
-            free(ready_process);
             // printf("time: %d ready_queue count: %d\n", count_time, ready_queue.count);
 
             // CPU가 1개로 가정했기 때문에 running state에는 1개의 프로세스만 온다
@@ -489,9 +626,8 @@ int main(int argc, char** argv) {
                 }
                 // ready_queue에 process가 있는 경우 가져와서 running으로
                 else {
-                    pcb tmp = dequeue(&ready_queue);
-                    tmp.ready_end_time = count_time;
-                    tmp.waiting_time += (tmp.ready_end_time - tmp.ready_start_time);
+                    pcb* tmp = dequeue(&ready_queue);
+                    ready_out(tmp, count_time);
                     enqueue(&running_queue, tmp);
                 }
             }
@@ -502,15 +638,11 @@ int main(int argc, char** argv) {
 
                 // CPU time만큼 running state에 있었으면 프로세스를 종료하고 complete_queue로 보낸다
                 if (running_queue.first->remaining_cpu_time == 0) {
-                    pcb tmp = dequeue(&running_queue);
-                    tmp.completion_time = count_time;
-                    tmp.turnaround_time = tmp.completion_time - tmp.A;
-
-                    total_turnaround_time += tmp.turnaround_time;
-                    total_waiting_time += tmp.waiting_time;
-                    total_blocked_time += tmp.blocked_time;
-
+                    pcb* tmp = dequeue(&running_queue);
+                    complete(tmp, count_time);
+#ifndef LARGE_SCALE
                     enqueue(&complete_queue, tmp);
+#endif
                     finished_count++;
                 }
                 // 현재 running process 의 cpu burst time이 0가 되면
@@ -522,32 +654,33 @@ int main(int argc, char** argv) {
                     }
                     // ioburst != 0 일 경우 IO작업을 하기 위해 blocked queue로 보냄
                     else {
-                        pcb tmp = dequeue(&running_queue);
+                        pcb* tmp = dequeue(&running_queue);
                         // IO작업을 위해 blocked_queue로 보낸다
-                        tmp.blocked_start_time = count_time;
+                        blocked_in(tmp, count_time);
                         // remaining_ioburst ioburst 를 다시 초기화 해준다
-                        tmp.remaining_ioburst = tmp.ioburst;
+                        tmp->remaining_ioburst = tmp->ioburst;
                         enqueue(&blocked_queue, tmp);
                     }
                 }
             }
 
+            PROF_LAP(PHASE_DISPATCH);
+
             // blocked_queue가 비어있지 않으면
             // io도 한 번에 1개의 프로세스만 io작업을 한다고 가정
             if (!is_empty(&blocked_queue)) {
                 // blocked_queue에 있는 프로세스의 수만큼 for문을 돌리기 위해
                 int process_count = blocked_queue.count;
                 for (int i = 0; i < process_count; ++i) {
-                    pcb tmp = dequeue(&blocked_queue);
-                    tmp.remaining_ioburst--;
+                    pcb* tmp = dequeue(&blocked_queue);
+                    tmp->remaining_ioburst--;
 
                     //block queue에 있는 io작업이 끝난 프로세스가 있으면
-                    if (tmp.remaining_ioburst == 0) {
-                        tmp.blocked_end_time = count_time;
-                        tmp.blocked_time += (tmp.blocked_end_time - tmp.blocked_start_time);
-                        tmp.remaining_cburst = tmp.cburst;
-                        tmp.ready_start_time = count_time;
-                        enqueue(&ready_queue, tmp);
+                    if (tmp->remaining_ioburst == 0) {
+                        blocked_out(tmp, count_time);
+                        tmp->remaining_cburst = tmp->cburst;
+                        ready_in(tmp, count_time);
+                        enqueue_sorted(&ready_queue, tmp);
                     }
                     // 아직 IO 작업이 남아있으면 다시 blocked_queue에 넣어준다
                     else {
@@ -555,6 +688,7 @@ int main(int argc, char** argv) {
                     }
                 }
             }
+            PROF_LAP(PHASE_BLOCKED);
 
             // 모든 프로세스가 완료되면 Finishing time을 기록하고 while반복문을 빠져나간다.
             if (finished_count == number_of_processes) {
@@ -563,6 +697,7 @@ int main(int argc, char** argv) {
             }
 
             count_time++;
+            PROF_COUNT(ticks);
         }
     }
     // argv[2] 의 값이 제대로 주어지지 않았으면 ("fcfs", "sjf", 또는 "rr"이 아니면)
@@ -573,41 +708,46 @@ int main(int argc, char** argv) {
     // 정상적으로 프로그램이 종료되었을 때만 출력
     if (is_all_finished == true) {
         // 결과 출력을 위한 계산식들
-        avg_turnaround_time = total_turnaround_time / (double)number_of_processes;
-        avg_waiting_time = total_waiting_time / (double)number_of_processes;
-        throughput_per_unit = (double)number_of_processes / finishing_time;
-
-        cpu_util = (finishing_time - idle_time) / (double)finishing_time;
-        io_util = total_blocked_time / (double)finishing_time;
-
-        // 결과 출력
+        // 64비트 합계를 먼저 double로 바꾼 뒤 나눈다 (정수 나눗셈으로 인한 절삭이나 overflow가 없도록)
+        // 프로세스는 최소 1 time unit의 CPU time이 필요하므로 finishing_time은 항상 0보다 크다
+        double elapsed_time = (double)finishing_time;
+        avg_turnaround_time = (double)total_turnaround_time / number_of_processes;
+        avg_waiting_time = (double)total_waiting_time / number_of_processes;
+        throughput_per_unit = number_of_processes / elapsed_time;
+
+        cpu_util = (double)(finishing_time - idle_time) / elapsed_time;
+        io_util = (double)total_blocked_time / elapsed_time;
+
+#ifndef LARGE_SCALE
+        // 결과 출력 (LARGE_SCALE 모드에서는 프로세스별 결과를 저장하지 않으므로 SUMMARY만 출력)
         int process_print_index = complete_queue.count;
         for (int i = 0; i < process_print_index; ++i) {
-            pcb tmp = dequeue(&complete_queue);
+            pcb* tmp = dequeue(&complete_queue);
             printf(
                 "-----------------------pid[%d]---------------------\n"
-                "(A: %d  C: %d  B: %d  IO: %d)\n"
+                "(A: %" PRId64 "  C: %d  B: %d  IO: %d)\n"
                 "(CPU burst: %d  IO burst: %d)\n"
-                "Finishing time\t\t:%8d time units\n"
-                "Turnaround time\t\t:%8d time units\n"
+                "Finishing time\t\t:%8" PRId64 " time units\n"
+                "Turnaround time\t\t:%8" PRId64 " time units\n"
                 "CPU time\t\t:%8d time units\n"
-                "IO time\t\t\t:%8d time units\n"
-                "Waiting time\t\t:%8d time units\n"
+                "IO time\t\t\t:%8" PRId64 " time units\n"
+                "Waiting time\t\t:%8" PRId64 " time units\n"
                 "---------------------------------------------------\n\n",
-                tmp.pid,
-                tmp.A, tmp.C, tmp.B, tmp.IO,
-                tmp.cburst, tmp.ioburst,
-                tmp.completion_time,  // Finishing time of the process
-                tmp.turnaround_time,
-                tmp.C,             // CPU time
-                tmp.blocked_time,  // IO time
-                tmp.waiting_time);
+                (int)(tmp - process),  // pid
+                tmp->A, tmp->C, tmp->B, tmp->IO,
+                tmp->cburst, tmp->ioburst,
+                tmp->completion_time,  // Finishing time of the process
+                tmp->turnaround_time,
+                tmp->C,             // CPU time
+                tmp->blocked_time,  // IO time
+                tmp->waiting_time);
         }
+#endif
 
         printf("\n~~~~~~~~~~~~~~~~~~~~~~~~SUMMARY~~~~~~~~~~~~~~~~~~~~~~~~\n\n");
         printf(
             "----------------%s----------------\n"
-            "Finishing time\t\t\t:%10d time units\n"
+            "Finishing time\t\t\t:%10" PRId64 " time units\n"
             "CPU Utilization\t\t\t:%10.1f %%\n"
             "IO Utilization\t\t\t:%10.1f %%\n"
             "Throughput per 100 time units\t:%10f processes\n"
@@ -620,6 +760,19 @@ int main(int argc, char** argv) {
         printf("------------------------------------------------------------\n\n");
     }
 
+#ifdef PROFILE
+    if (prof_enabled && is_all_finished) {
+        prof.peak_ready_queue = ready_queue.peak;
+        prof.peak_blocked_queue = blocked_queue.peak;
+        prof_report();
+        if (!prof_write_json(profile_path)) {
+            printf("Error! Could not write the profile to %s\n", profile_path);
+            free(process);
+            return 1;
+        }
+    }
+#endif
+
     // 메모리 할당을 해준 프로세스 구조체 배열 할당 해제
     free(process);
 
@@ -630,36 +783,71 @@ void queue_init(queue_t* queue) {
     queue->count = 0;
     queue->first = NULL;
     queue->last = NULL;
+#ifdef PROFILE
+    queue->peak = 0;
+#endif
 }
 
 bool is_empty(queue_t* queue) {
     return (queue->count == 0);
 }
 
-void enqueue(queue_t* queue, pcb process) {
-    node* n = (node*)malloc(sizeof(node));
-    if (n == NULL) {
-        return;
-    }
-    n->process = process;
-    n->next = NULL;
+void enqueue(queue_t* queue, pcb* p) {
+    p->link = LINK_NONE;
 
     // queue가 비어있으면
     if (is_empty(queue)) {
-        queue->first = &n->process;
-        queue->last = &n->process;
+        queue->first = p;
+        queue->last = p;
     }
     //queue가 비어있지 않으면(이미 저장된 item이 있으면)
     else {
-        queue->last->link = &n->process;
-        queue->last = &n->process;
+        queue->last->link = PCB_TO_LINK(p);
+        queue->last = p;
+    }
+    queue->count++;
+
+    PROF_COUNT(enqueues);
+#ifdef PROFILE
+    if (queue->count > queue->peak) {
+        queue->peak = queue->count;
+    }
+#endif
+}
+
+void enqueue_sorted(queue_t* queue, pcb* p) {
+    // 맨 뒤에 넣어도 순서가 유지되는 경우
+    if (is_empty(queue) || queue->last->remaining_cpu_time <= p->remaining_cpu_time) {
+        enqueue(queue, p);
+        return;
+    }
+
+    // remaining_cpu_time이 p보다 큰 첫 번째 pcb의 앞에 넣는다
+    pcb* prev = NULL;
+    pcb* cur = queue->first;
+    while (cur->remaining_cpu_time <= p->remaining_cpu_time) {
+        PROF_COUNT(ready_queue_steps);
+        prev = cur;
+        cur = LINK_TO_PCB(cur->link);
+    }
+    p->link = PCB_TO_LINK(cur);
+    if (prev == NULL) {
+        queue->first = p;
+    } else {
+        prev->link = PCB_TO_LINK(p);
     }
     queue->count++;
+
+    PROF_COUNT(enqueues);
+#ifdef PROFILE
+    if (queue->count > queue->peak) {
+        queue->peak = queue->count;
+    }
+#endif
 }
 
-pcb dequeue(queue_t* queue) {
+pcb* dequeue(queue_t* queue) {
     pcb* tmp;
-    pcb process;
     // if ((queue->first == NULL) && (queue->last == NULL)) {
     if (is_empty(queue)) {
         printf("Queue is Empty!\n");
@@ -667,10 +855,167 @@ pcb dequeue(queue_t* queue) {
     } else {
         tmp = queue->first;
 
-        queue->first = queue->first->link;
+        queue->first = LINK_TO_PCB(tmp->link);
     }
-    process = *tmp;
-    free(tmp);
     queue->count--;
-    return process;
+
+    PROF_COUNT(dequeues);
+    return tmp;
+}
+
+int compare_arrival(const void* a, const void* b) {
+    const pcb* p = a;
+    const pcb* q = b;
+    if (p->A != q->A) {
+        return (p->A < q->A) ? -1 : 1;
+    }
+    return (p->link < q->link) ? -1 : (p->link > q->link);
+}
+
+int compare_arrival_cpu_time(const void* a, const void* b) {
+    const pcb* p = a;
+    const pcb* q = b;
+    // 정렬 시점에는 remaining_cpu_time == C
+    if (p->A != q->A) {
+        return (p->A < q->A) ? -1 : 1;
+    }
+    if (p->remaining_cpu_time != q->remaining_cpu_time) {
+        return (p->remaining_cpu_time < q->remaining_cpu_time) ? -1 : 1;
+    }
+    return (p->link < q->link) ? -1 : (p->link > q->link);
+}
+
+void ready_in(pcb* p, sim_time_t now) {
+    PROF_COUNT(events);
+#ifdef LARGE_SCALE
+    // ready_queue에서 나올 때 now를 더하므로 waiting time의 합계만 남는다
+    (void)p;
+    total_waiting_time -= now;
+#else
+    p->ready_start_time = now;
+#endif
+}
+
+void ready_out(pcb* p, sim_time_t now) {
+    PROF_COUNT(events);
+    PROF_COUNT(context_switches);
+#ifdef LARGE_SCALE
+    (void)p;
+    total_waiting_time += now;
+#else
+    p->ready_end_time = now;
+    p->waiting_time += (p->ready_end_time - p->ready_start_time);
+#endif
+}
+
+void blocked_in(pcb* p, sim_time_t now) {
+    PROF_COUNT(events);
+#ifdef LARGE_SCALE
+    (void)p;
+    total_blocked_time -= now;
+#else
+    p->blocked_start_time = now;
+#endif
+}
+
+void blocked_out(pcb* p, sim_time_t now) {
+#ifdef LARGE_SCALE
+    (void)p;
+    total_blocked_time += now;
+#else
+    p->blocked_end_time = now;
+    p->blocked_time += (p->blocked_end_time - p->blocked_start_time);
+#endif
+}
+
+void complete(pcb* p, sim_time_t now) {
+    PROF_COUNT(events);
+#ifdef LARGE_SCALE
+    total_turnaround_time += now - p->A;
+#else
+    p->completion_time = now;
+    p->turnaround_time = p->completion_time - p->A;
+
+    total_turnaround_time += p->turnaround_time;
+    total_waiting_time += p->waiting_time;
+    total_blocked_time += p->blocked_time;
+#endif
+}
+
+#ifdef PROFILE
+const char* prof_phase_names[PHASE_COUNT] = {"setup", "arrival", "dispatch", "blocked"};
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PROF_TIMER_UNIT "cycles"
+
+uint64_t prof_timer(void) {
+    return __rdtsc();
+}
+#else
+#define PROF_TIMER_UNIT "ns"
+
+uint64_t prof_timer(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+void prof_lap(enum prof_phase phase) {
+    uint64_t now = prof_timer();
+    prof.phase_time[phase] += now - prof_last_time;
+    prof_last_time = now;
+}
+
+void prof_report(void) {
+    uint64_t total = 0;
+    for (int i = 0; i < PHASE_COUNT; ++i) {
+        total += prof.phase_time[i];
+    }
+
+    printf("~~~~~~~~~~~~~~~~~~~~~~~~PROFILE~~~~~~~~~~~~~~~~~~~~~~~~\n\n");
+    for (int i = 0; i < PHASE_COUNT; ++i) {
+        printf("%-12s\t\t:%16" PRIu64 " " PROF_TIMER_UNIT " (%5.1f %%)\n",
+               prof_phase_names[i], prof.phase_time[i], total > 0 ? prof.phase_time[i] * 100.0 / total : 0.0);
+    }
+    printf(
+        "------------------------------------------------------------\n"
+        "Ticks\t\t\t:%16" PRIu64 "\n"
+        "Events\t\t\t:%16" PRIu64 "\n"
+        "Context switches\t:%16" PRIu64 "\n"
+        "Ready queue steps\t:%16" PRIu64 "\n"
+        "Enqueues\t\t:%16" PRIu64 "\n"
+        "Dequeues\t\t:%16" PRIu64 "\n"
+        "Allocations\t\t:%16" PRIu64 "\n"
+        "Peak ready queue\t:%16d\n"
+        "Peak blocked queue\t:%16d\n"
+        "------------------------------------------------------------\n\n",
+        prof.ticks, prof.events, prof.context_switches, prof.ready_queue_steps, prof.enqueues, prof.dequeues, prof.allocations,
+        prof.peak_ready_queue, prof.peak_blocked_queue);
+}
+
+bool prof_write_json(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+
+    fprintf(file, "{\n  \"algorithm\": \"%s\",\n  \"quantum\": %d,\n  \"processes\": %d,\n  \"finishing_time\": %" PRId64 ",\n",
+            sched_algorithm_title, quantum, number_of_processes, finishing_time);
+    fprintf(file, "  \"timer_unit\": \"" PROF_TIMER_UNIT "\",\n  \"phases\": {");
+    for (int i = 0; i < PHASE_COUNT; ++i) {
+        fprintf(file, "%s\"%s\": %" PRIu64, i == 0 ? "" : ", ", prof_phase_names[i], prof.phase_time[i]);
+    }
+    fprintf(file,
+            "},\n"
+            "  \"counters\": {\"ticks\": %" PRIu64 ", \"events\": %" PRIu64 ", \"context_switches\": %" PRIu64
+            ", \"ready_queue_steps\": %" PRIu64 ", \"enqueues\": %" PRIu64 ", \"dequeues\": %" PRIu64 ", \"allocations\": %" PRIu64 "},\n"
+            "  \"peak_queue_length\": {\"ready\": %d, \"blocked\": %d}\n"
+            "}\n",
+            prof.ticks, prof.events, prof.context_switches, prof.ready_queue_steps, prof.enqueues, prof.dequeues, prof.allocations,
+            prof.peak_ready_queue, prof.peak_blocked_queue);
+
+    fclose(file);
+    return true;
 }
+#endif